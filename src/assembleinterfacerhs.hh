@@ -19,6 +19,23 @@ void assembleInterfaceRHS(DiscreteFunctionType& rhs,const OperatorType& op)
   rhs.template subDiscreteFunction<1>()*=-1.0;
 }
 
+// add the previous displacement contribution to the curvature equation of a two step scheme whose discrete time derivative
+// is (newCoeff dX^m + oldCoeff dX^{m-1})/dt, the operator is assembled with newCoeff hence its coupling is -newCoeff/dt N^T
+template<typename DiscreteFunctionType,typename OperatorType,typename DisplacementFunctionType>
+void addBDF2InterfaceRHS(DiscreteFunctionType& rhs,const OperatorType& op,const DisplacementFunctionType& oldDisplacement,
+                         double newCoeff,double oldCoeff)
+{
+  DiscreteFunctionType temp("temp",rhs.space());
+  temp.template subDiscreteFunction<0>().clear();
+  temp.template subDiscreteFunction<1>().assign(oldDisplacement);
+
+  DiscreteFunctionType oldContribution("old contribution",rhs.space());
+  op(temp,oldContribution);
+
+  // oldCoeff/dt N^T dX^{m-1}
+  rhs.template subDiscreteFunction<0>().axpy(-oldCoeff/newCoeff,oldContribution.template subDiscreteFunction<0>());
+}
+
 }
 }
 
@@ -71,6 +71,12 @@ void computeInterface(FemSchemeType& femScheme)
           interfaceStationary=false;
           break;
         }
+      // frozen vertices have null displacement, hence check again on the whole interface
+      if(interfaceStationary&&!femScheme.isLastSolveOnWholeInterface())
+      {
+        femScheme.resetActiveSet();
+        interfaceStationary=false;
+      }
       if(interfaceStationary)
         std::cout<<"Interface is stationary.\n";
       else
@@ -78,6 +84,8 @@ void computeInterface(FemSchemeType& femScheme)
     }
     // update grid
     grid.coordFunction()+=displacement;
+    // adapt grid to the curvature
+    femScheme.adapt(solution,timeProvider);
     // stop timer
     timer.stop();
     std::cout<<"Time elapsed for assembling and solving : "<<timer.elapsed()<<" seconds.\n";
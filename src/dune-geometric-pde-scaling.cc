@@ -0,0 +1,310 @@
+#ifndef POLORDER
+#define POLORDER 1
+#endif
+
+#ifndef SOLVER_TYPE
+#define SOLVER_TYPE 0 // 0 UMFPACK, 1 SPQR, 4 single precision SuperLU with iterative refinement
+#endif
+
+#include "config.h"
+#include <dune/common/exceptions.hh>
+#include <dune/common/timer.hh>
+#include <dune/grid/albertagrid.hh>
+#include <dune/grid/io/file/gmshreader.hh>
+#include <dune/grid/common/gridfactory.hh>
+#include <dune/grid/geometrygrid/grid.hh>
+#include <dune/fem/misc/mpimanager.hh>
+#include <dune/fem/io/io.hh>
+#include <dune/fem/io/parameter.hh>
+#include <dune/fem/solver/timeprovider.hh>
+
+#if SOLVER_TYPE == 0
+#include <umfpack.h>
+#elif SOLVER_TYPE == 1
+#include <SuiteSparseQR.hpp>
+#endif
+
+#include <SuiteSparse_config.h>
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "vertexfunction.hh"
+#include "interfacehierarchy.hh"
+#include "femschemeinterface.hh"
+
+// peak resident memory in kB
+long peakMemory()
+{
+  struct rusage usage;
+  getrusage(RUSAGE_SELF,&usage);
+  return usage.ru_maxrss;
+}
+
+// compressed column storage of the system matrix
+struct CCSMatrix
+{
+  template<typename MatrixType>
+  explicit CCSMatrix(const MatrixType& matrix):
+    size(matrix.rows()),colstart(size+1,0)
+  {
+    for(auto row=decltype(size){0};row!=size;++row)
+      for(auto idx=matrix.startRow(row);idx!=matrix.endRow(row);++idx)
+        if(static_cast<std::size_t>(matrix.realValue(idx).second)<size)
+          ++colstart[matrix.realValue(idx).second+1];
+    for(auto col=decltype(size){0};col!=size;++col)
+      colstart[col+1]+=colstart[col];
+    rowindex.resize(colstart[size]);
+    values.resize(colstart[size]);
+    std::vector<SuiteSparse_long> position(colstart.begin(),colstart.end()-1);
+    for(auto row=decltype(size){0};row!=size;++row)
+      for(auto idx=matrix.startRow(row);idx!=matrix.endRow(row);++idx)
+      {
+        const auto entry(matrix.realValue(idx));
+        if(static_cast<std::size_t>(entry.second)<size)
+        {
+          rowindex[position[entry.second]]=row;
+          values[position[entry.second]]=entry.first;
+          ++position[entry.second];
+        }
+      }
+  }
+
+  std::size_t nnz() const
+  {
+    return values.size();
+  }
+
+  // number of nonzeros of the factors computed by the direct solver
+  std::size_t factorNnz() const
+  {
+    #if SOLVER_TYPE == 0
+    void* symbolic(nullptr);
+    void* numeric(nullptr);
+    umfpack_dl_symbolic(size,size,colstart.data(),rowindex.data(),values.data(),&symbolic,nullptr,nullptr);
+    umfpack_dl_numeric(colstart.data(),rowindex.data(),values.data(),symbolic,&numeric,nullptr,nullptr);
+    SuiteSparse_long lnz(0);
+    SuiteSparse_long unz(0);
+    SuiteSparse_long nrow(0);
+    SuiteSparse_long ncol(0);
+    SuiteSparse_long nzud(0);
+    umfpack_dl_get_lunz(&lnz,&unz,&nrow,&ncol,&nzud,numeric);
+    umfpack_dl_free_symbolic(&symbolic);
+    umfpack_dl_free_numeric(&numeric);
+    return lnz+unz;
+    #elif SOLVER_TYPE == 1
+    cholmod_common cc;
+    cholmod_l_start(&cc);
+    cholmod_sparse* matrix(cholmod_l_allocate_sparse(size,size,nnz(),true,true,0,CHOLMOD_REAL,&cc));
+    std::copy(colstart.begin(),colstart.end(),static_cast<SuiteSparse_long*>(matrix->p));
+    std::copy(rowindex.begin(),rowindex.end(),static_cast<SuiteSparse_long*>(matrix->i));
+    std::copy(values.begin(),values.end(),static_cast<double*>(matrix->x));
+    auto* factorization(SuiteSparseQR_factorize<double>(SPQR_ORDERING_DEFAULT,SPQR_DEFAULT_TOL,matrix,&cc));
+    // nonzeros of R and of the Householder vectors
+    const std::size_t factorNnz(cc.SPQR_istat[0]+cc.SPQR_istat[1]);
+    SuiteSparseQR_free(&factorization,&cc);
+    cholmod_l_free_sparse(&matrix,&cc);
+    cholmod_l_finish(&cc);
+    return factorNnz;
+    #else
+    return 0;
+    #endif
+  }
+
+  const std::size_t size;
+  std::vector<SuiteSparse_long> colstart;
+  std::vector<SuiteSparse_long> rowindex;
+  std::vector<double> values;
+};
+
+// least squares slope of log(y) against log(x)
+double scalingExponent(const std::vector<double>& x,const std::vector<double>& y)
+{
+  double meanX(0.0);
+  double meanY(0.0);
+  std::size_t size(0);
+  for(auto i=decltype(x.size()){0};i!=x.size();++i)
+    if((x[i]>0.0)&&(y[i]>0.0))
+    {
+      meanX+=std::log(x[i]);
+      meanY+=std::log(y[i]);
+      ++size;
+    }
+  if(size<2)
+    return 0.0;
+  meanX/=static_cast<double>(size);
+  meanY/=static_cast<double>(size);
+  double covariance(0.0);
+  double variance(0.0);
+  for(auto i=decltype(x.size()){0};i!=x.size();++i)
+    if((x[i]>0.0)&&(y[i]>0.0))
+    {
+      covariance+=(std::log(x[i])-meanX)*(std::log(y[i])-meanY);
+      variance+=(std::log(x[i])-meanX)*(std::log(x[i])-meanX);
+    }
+  return variance>0.0?covariance/variance:0.0;
+}
+
+// run the scheme on a refinement level of the input mesh and append the measurements to the csv file
+void runConfiguration(const std::string& csvFileName,unsigned int level,bool useMeanCurvatureFlow)
+{
+  typedef Dune::AlbertaGrid<GRIDDIM,WORLDDIM> HostGridType;
+  typedef Dune::GeometryGrid<HostGridType,Dune::Fem::VertexFunction<HostGridType>> GridType;
+  typedef Dune::Fem::FemSchemeInterface<GridType> FemSchemeType;
+  const unsigned int timeSteps(Dune::Fem::Parameter::getValue<unsigned int>("ScalingTimeSteps",5));
+  Dune::Timer timer(false);
+  timer.start();
+
+  // load and refine grid
+  const std::string fileName(static_cast<std::string>(MSHFILESDIR)+Dune::Fem::Parameter::getValue<std::string>("FileName","mesh.msh"));
+  Dune::GridFactory<HostGridType> hostGridFactory;
+  std::vector<int> boundaryIDs(0);
+  std::vector<int> elementsIDs(0);
+  Dune::GmshReader<HostGridType>::read(hostGridFactory,fileName,boundaryIDs,elementsIDs);
+  std::unique_ptr<HostGridType> hostGrid(hostGridFactory.createGrid());
+  GridType grid(hostGrid.release());
+  Dune::Fem::globalRefineInterface(grid,level);
+
+  // run the scheme
+  FemSchemeType femScheme(grid,useMeanCurvatureFlow);
+  typename FemSchemeType::DiscreteFunctionType solution("solution",femScheme.space());
+  auto& displacement(solution.template subDiscreteFunction<1>());
+  Dune::Fem::FixedStepTimeProvider<> timeProvider;
+  femScheme.computeInitialCurvature(solution,timeProvider);
+  timeProvider.next();
+  double assembleTime(0.0);
+  double rhsTime(0.0);
+  double solveTime(0.0);
+  unsigned int refinementIterations(0);
+  for(auto step=decltype(timeSteps){0};step!=timeSteps;++step,timeProvider.next())
+  {
+    femScheme(solution,timeProvider);
+    grid.coordFunction()+=displacement;
+    assembleTime+=femScheme.assembleTime();
+    rhsTime+=femScheme.rhsTime();
+    solveTime+=femScheme.solveTime();
+    refinementIterations+=femScheme.refinementIterations();
+  }
+  timer.stop();
+
+  // dump measurements
+  // the peak memory is read before the diagnostic factorization used to count the factor nonzeros
+  const auto memory(peakMemory());
+  const CCSMatrix matrix(femScheme.systemOperator().systemMatrix().matrix());
+  const auto factorNnz(matrix.factorNnz());
+  std::ofstream csv(csvFileName,std::ios::app);
+  csv<<std::setprecision(10)<<SOLVER_TYPE<<","<<POLORDER<<","<<useMeanCurvatureFlow<<","<<level<<","<<grid.size(0)<<","
+    <<solution.size()<<","<<matrix.nnz()<<","<<factorNnz<<","<<static_cast<double>(factorNnz)/static_cast<double>(matrix.nnz())<<","
+    <<assembleTime<<","<<rhsTime<<","<<solveTime<<","<<timer.elapsed()<<","<<memory<<","
+    <<refinementIterations<<"\n";
+}
+
+int main(int argc,char** argv)
+{
+  try
+  {
+    // init
+    Dune::Fem::MPIManager::initialize(argc,argv);
+    Dune::Fem::Parameter::append(argc,argv);
+    const std::string parameterFileName(argc<2?(static_cast<std::string>(SOURCEDIR)+"/parameter"):argv[1]);
+    Dune::Fem::Parameter::append(parameterFileName);
+
+    // create csv file
+    const std::string& path(Dune::Fem::Parameter::getValue<std::string>("fem.prefix","."));
+    if(!Dune::Fem::directoryExists(path))
+      Dune::Fem::createDirectory(path);
+    const std::string baseFileName(path+"/scaling_solver"+std::to_string(SOLVER_TYPE)+"_order"+std::to_string(POLORDER));
+    const std::string csvFileName(baseFileName+".csv");
+
+    // a single configuration is run when the level is given
+    if(Dune::Fem::Parameter::exists("ScalingLevel"))
+    {
+      runConfiguration(csvFileName,Dune::Fem::Parameter::getValue<unsigned int>("ScalingLevel"),
+                       Dune::Fem::Parameter::getValue<bool>("UseMeanCurvatureFlow",0));
+      return 0;
+    }
+
+    // each configuration runs in its own process, hence the peak memory is measured independently
+    {
+      std::ofstream csv(csvFileName);
+      csv<<"solver,polorder,meancurvatureflow,level,elements,dofs,nnz,factornnz,fill,assembletime,rhstime,solvetime,totaltime,"
+        <<"peakmemory,refinementiterations\n";
+    }
+    const unsigned int refinementLevels(Dune::Fem::Parameter::getValue<unsigned int>("ScalingRefinementLevels",4));
+    for(const bool useMeanCurvatureFlow:{false,true})
+      for(auto level=decltype(refinementLevels){0};level<=refinementLevels;++level)
+      {
+        std::cout<<"Running level "<<level<<" with mean curvature flow "<<useMeanCurvatureFlow<<".\n";
+        const std::string command(static_cast<std::string>(argv[0])+" "+parameterFileName+" ScalingLevel:"+std::to_string(level)+
+                                  " UseMeanCurvatureFlow:"+std::to_string(useMeanCurvatureFlow)+" > /dev/null");
+        if(std::system(command.c_str())!=0)
+          DUNE_THROW(Dune::Exception,"scaling configuration failed: "<<command);
+      }
+
+    // fit the exponents of each quantity against the number of dofs
+    constexpr std::size_t dofsColumn(5);
+    std::vector<std::string> names;
+    std::vector<std::vector<std::vector<double>>> columns(2);
+    {
+      std::ifstream csv(csvFileName);
+      std::string line;
+      std::getline(csv,line);
+      std::stringstream header(line);
+      std::string name;
+      while(std::getline(header,name,','))
+        names.push_back(name);
+      while(std::getline(csv,line))
+      {
+        std::vector<double> row;
+        std::stringstream ss(line);
+        std::string value;
+        while(std::getline(ss,value,','))
+          row.push_back(std::stod(value));
+        auto& flowColumns(columns[static_cast<std::size_t>(row[2])]);
+        flowColumns.resize(row.size());
+        for(auto i=decltype(row.size()){0};i!=row.size();++i)
+          flowColumns[i].push_back(row[i]);
+      }
+    }
+    const std::string exponentsFileName(baseFileName+"_exponents.csv");
+    std::ofstream exponents(exponentsFileName);
+    exponents<<"solver,polorder,meancurvatureflow";
+    for(auto i=dofsColumn+1;i<names.size();++i)
+      exponents<<","<<names[i];
+    exponents<<"\n";
+    for(auto flow=decltype(columns.size()){0};flow!=columns.size();++flow)
+    {
+      const auto& flowColumns(columns[flow]);
+      if(flowColumns.empty())
+        continue;
+      exponents<<SOLVER_TYPE<<","<<POLORDER<<","<<flow;
+      for(auto i=dofsColumn+1;i<flowColumns.size();++i)
+        exponents<<","<<scalingExponent(flowColumns[dofsColumn],flowColumns[i]);
+      exponents<<"\n";
+    }
+    std::cout<<"\nScaling results dumped into "<<csvFileName<<" and the exponents against the dofs into "<<exponentsFileName<<".\n";
+
+    return 0;
+  }
+
+  catch(std::exception& e)
+  {
+    throw;
+  }
+
+  catch(...)
+  {
+    std::cerr<<"Unknown exception thrown!\n";
+    exit(1);
+  }
+}
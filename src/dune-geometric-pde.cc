@@ -1,6 +1,7 @@
 #define POLORDER 1
 
-#define SOLVER_TYPE 0 // 0 UMFPACK, 1 SPQR
+#define SOLVER_TYPE 0 // 0 UMFPACK, 1 SPQR, 2 GMRES with multigrid preconditioner, 3 single precision 2 with iterative refinement,
+                      // 4 single precision SuperLU with iterative refinement
 
 #include "config.h"
 #include <dune/common/timer.hh>
@@ -19,6 +20,7 @@
 #include <vector>
 
 #include "vertexfunction.hh"
+#include "interfacehierarchy.hh"
 #include "femschemeinterface.hh"
 #include "computeinterface.hh"
 
@@ -48,6 +50,10 @@ int main(int argc,char** argv)
     typedef Dune::GeometryGrid<HostGridType,Dune::Fem::VertexFunction<HostGridType>> GridType;
     GridType grid(hostGrid.release());
 
+    // refine grid globally, the levels are used by the multigrid preconditioner
+    const unsigned int refinementLevels(Dune::Fem::Parameter::getValue<unsigned int>("RefinementLevels",0));
+    Dune::Fem::globalRefineInterface(grid,refinementLevels);
+
     // load problem type
     const bool useMeanCurvatureFlow(Dune::Fem::Parameter::getValue<bool>("UseMeanCurvatureFlow",0));
     if(useMeanCurvatureFlow)
@@ -69,6 +75,9 @@ int main(int argc,char** argv)
         Dune::Fem::createDirectory(path);
       Dune::GmshWriter<typename GridType::LeafGridView> gmshWriter(grid.leafGridView());
       gmshWriter.setPrecision(15);
+      // the physical entities are lost if the mesh has been refined or adapted
+      if((refinementLevels>0)||femScheme.isAdapted())
+        elementsIDs.clear();
       gmshWriter.write(path+"/"+fileNameFinalMesh,elementsIDs);
       std::cout<<"\nFinal mesh dumped into "<<fileNameFinalMesh<<".\n";
     }
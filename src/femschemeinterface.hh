@@ -1,16 +1,34 @@
 #ifndef DUEN_FEM_FEMSCHEMEINTERFACE_HH
 #define DUEN_FEM_FEMSCHEMEINTERFACE_HH
 
-#include <dune/fem/gridpart/leafgridpart.hh>
+#include <dune/common/exceptions.hh>
+#include <dune/common/timer.hh>
+#include <dune/geometry/referenceelements.hh>
+#include <dune/fem/function/common/localcontribution.hh>
+#include <dune/fem/function/localfunction/const.hh>
+#include <dune/fem/gridpart/adaptiveleafgridpart.hh>
+#include <dune/fem/io/parameter.hh>
+#include <dune/fem/space/common/adaptationmanager.hh>
 #include <dune/fem/space/common/functionspace.hh>
+#include <dune/fem/space/common/restrictprolongtuple.hh>
 #include <dune/fem/space/lagrange.hh>
 #include <dune/fem/function/tuplediscretefunction.hh>
 #include <dune/fem/function/adaptivefunction.hh>
 #include <dune/fem/solver/umfpacksolver.hh>
 #include <dune/fem/solver/spqrsolver.hh>
 
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
 #include "interfaceoperator.hh"
 #include "assembleinterfacerhs.hh"
+#include "multigridinverseoperator.hh"
+#include "mixedprecisioninverseoperator.hh"
 
 namespace Dune
 {
@@ -24,13 +42,16 @@ class FemSchemeInterface
   // define grid types
   typedef GridImp GridType;
   typedef FemSchemeInterface<GridType> ThisType;
-  typedef LeafGridPart<GridType> GridPartType;
+  typedef AdaptiveLeafGridPart<GridType> GridPartType;
 
   // define spaces and functions
   typedef FunctionSpace<double,double,GridType::dimensionworld,1> CurvatureContinuosSpaceType;
   typedef FunctionSpace<double,double,GridType::dimensionworld,GridType::dimensionworld> DisplacementContinuosSpaceType;
   typedef LagrangeDiscreteFunctionSpace<CurvatureContinuosSpaceType,GridPartType,POLORDER> CurvatureDiscreteSpaceType;
   typedef LagrangeDiscreteFunctionSpace<DisplacementContinuosSpaceType,GridPartType,POLORDER> DisplacementDiscreteSpaceType;
+  // the assembly takes the local curvature dofs to be the vertices and the grid is moved adding the displacement to the
+  // vertex coordinates, hence only linear elements are supported
+  static_assert(POLORDER==1,"the interface scheme requires linear elements");
   typedef AdaptiveDiscreteFunction<CurvatureDiscreteSpaceType> CurvatureDiscreteFunctionType;
   typedef AdaptiveDiscreteFunction<DisplacementDiscreteSpaceType> DisplacementDiscreteFunctionType;
   typedef TupleDiscreteFunction<CurvatureDiscreteFunctionType,DisplacementDiscreteFunctionType> DiscreteFunctionType;
@@ -44,11 +65,43 @@ class FemSchemeInterface
   typedef UMFPACKInverseOperator<DiscreteFunctionType,typename InterfaceOperatorType::MatrixType> InterfaceInverseOperatorType;
   #elif SOLVER_TYPE == 1
   typedef SPQRInverseOperator<DiscreteFunctionType,false,typename InterfaceOperatorType::MatrixType> InterfaceInverseOperatorType;
+  #elif SOLVER_TYPE == 2
+  static_assert(POLORDER==1,"the multigrid preconditioner requires linear elements");
+  typedef MultigridInverseOperator<DiscreteFunctionType,typename InterfaceOperatorType::LinearOperatorType> InterfaceInverseOperatorType;
+  #elif SOLVER_TYPE == 3
+  static_assert(POLORDER==1,"the multigrid preconditioner requires linear elements");
+  typedef MultigridInverseOperator<DiscreteFunctionType,typename InterfaceOperatorType::LinearOperatorType,float>
+    InterfaceInverseOperatorType;
+  #elif SOLVER_TYPE == 4
+  typedef MixedPrecisionInverseOperator<DiscreteFunctionType,typename InterfaceOperatorType::LinearOperatorType>
+    InterfaceInverseOperatorType;
   #endif
 
   explicit FemSchemeInterface(GridType& grid,bool useMeanCurvFlow):
-    grid_(grid),gridpart_(grid_),space_(gridpart_),usemeancurvflow_(useMeanCurvFlow)
-  {}
+    grid_(grid),gridpart_(grid_),space_(gridpart_),usemeancurvflow_(useMeanCurvFlow),
+    useactiveset_(Parameter::getValue<bool>("UseActiveSet",0)),
+    activesettolerance_(Parameter::getValue<double>("ActiveSetTolerance",1.e-10)),
+    activesetrefreshsteps_(Parameter::getValue<unsigned int>("ActiveSetRefreshSteps",10)),
+    activesetfreezesteps_(Parameter::getValue<unsigned int>("ActiveSetFreezeSteps",3)),
+    activeset_("active set",space_),stepssincerefresh_(0),lastsolveonwholeinterface_(true),usebdf2_(Parameter::getValue<bool>("UseBDF2",0)),
+    olddisplacement_("old displacement",space_.template subDiscreteFunctionSpace<1>()),hasolddisplacement_(false),
+    op_(space_,usemeancurvflow_),useadaptation_(Parameter::getValue<bool>("UseAdaptation",0)),
+    adaptationsteps_(Parameter::getValue<unsigned int>("AdaptationSteps",1)),
+    refinetolerance_(Parameter::getValue<double>("AdaptationRefineTolerance",1.e-1)),
+    coarsentolerance_(Parameter::getValue<double>("AdaptationCoarsenTolerance",1.e-2)),
+    maxlevel_(Parameter::getValue<int>("AdaptationMaxLevel",4)),isadapted_(false),assembletime_(0.0),rhstime_(0.0),solvetime_(0.0),refinementiterations_(0)
+  {
+    if(activesetfreezesteps_==0)
+      DUNE_THROW(InvalidStateException,"ActiveSetFreezeSteps must be at least 1");
+    if(adaptationsteps_==0)
+      DUNE_THROW(InvalidStateException,"AdaptationSteps must be at least 1");
+    #if (SOLVER_TYPE == 2) || (SOLVER_TYPE == 3)
+    if(useadaptation_)
+      DUNE_THROW(NotImplemented,"the multigrid preconditioner requires a globally refined interface");
+    #endif
+    resetActiveSet();
+    checkVertexNumbering();
+  }
 
   FemSchemeInterface(const ThisType& )=delete;
 
@@ -64,6 +117,30 @@ class FemSchemeInterface
   {
     return space_;
   }
+  const InterfaceOperatorType& systemOperator() const
+  {
+    return op_;
+  }
+
+  // time spent in each phase of the last solution computation
+  double assembleTime() const
+  {
+    return assembletime_;
+  }
+  double rhsTime() const
+  {
+    return rhstime_;
+  }
+  double solveTime() const
+  {
+    return solvetime_;
+  }
+
+  // iterative refinement iterations of the last solution computation, null for the double precision direct solvers
+  unsigned int refinementIterations() const
+  {
+    return refinementiterations_;
+  }
 
   // compute intial curvature
   template<typename TimeProviderType>
@@ -76,25 +153,236 @@ class FemSchemeInterface
   template<typename TimeProviderType>
   void operator()(DiscreteFunctionType& solution,const TimeProviderType& timeProvider,bool velocityNotNull=true)
   {
+    // the initial curvature is always computed on the whole interface
+    const bool useActiveSet(useactiveset_&&velocityNotNull);
+    lastsolveonwholeinterface_=(!useActiveSet)||isActiveSetFull();
+    // store values of frozen dofs: old curvature and null displacement
+    std::unique_ptr<DiscreteFunctionType> constraints(nullptr);
+    if(useActiveSet)
+    {
+      constraints.reset(new DiscreteFunctionType("constraints",space_));
+      constraints->assign(solution);
+      constraints->template subDiscreteFunction<1>().clear();
+    }
+    // BDF2 needs the previous displacement, hence the first time step is done with backward Euler
+    const bool useBDF2(usebdf2_&&velocityNotNull&&hasolddisplacement_);
+    // coefficients of the discrete time derivative (3/2 dX^m - 1/2 dX^{m-1})/dt, backward Euler is dX^m/dt
+    const double newDisplacementCoeff(useBDF2?1.5:1.0);
+    const double oldDisplacementCoeff(-0.5);
     // clear solution
     solution.clear();
-    // assemble operator
-    InterfaceOperatorType op(space_,usemeancurvflow_);
-    op.assemble(timeProvider,velocityNotNull);
+    Timer timer(false);
+    // assemble operator, with BDF2 normals and geometry are extrapolated from the previous displacement
+    timer.start();
+    // the coordinates are restored from a copy since subtracting the displacement back would accumulate rounding errors
+    typedef std::decay_t<decltype(grid_.coordFunction().discreteFunction())> CoordinatesType;
+    std::unique_ptr<CoordinatesType> coordinates(nullptr);
+    if(useBDF2)
+    {
+      coordinates.reset(new CoordinatesType("coordinates",grid_.coordFunction().discreteFunction().space()));
+      coordinates->assign(grid_.coordFunction().discreteFunction());
+      grid_.coordFunction()+=olddisplacement_;
+    }
+    op_.assemble(timeProvider,velocityNotNull,newDisplacementCoeff,useActiveSet?&activeset_:nullptr);
+    if(useBDF2)
+      grid_.coordFunction()=*coordinates;
+    assembletime_=timer.stop();
     // assemble rhs
+    timer.reset();
+    timer.start();
     DiscreteFunctionType rhs("interface RHS",space_);
-    assembleInterfaceRHS(rhs,op);
+    assembleInterfaceRHS(rhs,op_);
+    if(useBDF2)
+      addBDF2InterfaceRHS(rhs,op_,olddisplacement_,newDisplacementCoeff,oldDisplacementCoeff);
+    if(useActiveSet)
+    {
+      constrainDofs(rhs.template subDiscreteFunction<0>(),activeset_.template subDiscreteFunction<0>(),
+                    constraints->template subDiscreteFunction<0>());
+      constrainDofs(rhs.template subDiscreteFunction<1>(),activeset_.template subDiscreteFunction<1>(),
+                    constraints->template subDiscreteFunction<1>());
+    }
+    rhstime_=timer.stop();
     // solve the linear system
-    InterfaceInverseOperatorType interfaceInvOp;
-    interfaceInvOp.bind(op.systemMatrix());
-    interfaceInvOp(rhs,solution);
+    timer.reset();
+    timer.start();
+    invop_.bind(op_.systemMatrix());
+    invop_(rhs,solution);
+    invop_.unbind();
+    solvetime_=timer.stop();
+    #if SOLVER_TYPE >= 2
+    refinementiterations_=invop_.refinementIterations();
+    #endif
+    // store displacement for the next time step
+    if(usebdf2_&&velocityNotNull)
+    {
+      olddisplacement_.assign(solution.template subDiscreteFunction<1>());
+      hasolddisplacement_=true;
+    }
+    // update active set
+    if(useActiveSet)
+      updateActiveSet(solution);
+  }
+
+  // check if the whole interface is active
+  bool isActiveSetFull() const
+  {
+    const auto& activeCurvature(activeset_.template subDiscreteFunction<0>());
+    return std::all_of(activeCurvature.dbegin(),activeCurvature.dend(),[](const auto& dof){return dof>0.5;});
+  }
+
+  // check if the last solution has been computed on the whole interface
+  bool isLastSolveOnWholeInterface() const
+  {
+    return lastsolveonwholeinterface_;
+  }
+
+  // activate all the vertices of the interface
+  void resetActiveSet()
+  {
+    std::fill(activeset_.template subDiscreteFunction<0>().dbegin(),activeset_.template subDiscreteFunction<0>().dend(),1.0);
+    std::fill(activeset_.template subDiscreteFunction<1>().dbegin(),activeset_.template subDiscreteFunction<1>().dend(),1.0);
+    stepssincerefresh_=0;
+    stillsteps_.assign(activeset_.template subDiscreteFunction<0>().size(),0);
+  }
+
+  // check if the grid has ever been adapted
+  bool isAdapted() const
+  {
+    return isadapted_;
+  }
+
+  // refine the entities where the curvature is under-resolved and coarsen the ones where it is over-resolved
+  template<typename TimeProviderType>
+  void adapt(DiscreteFunctionType& solution,const TimeProviderType& timeProvider)
+  {
+    if((!useadaptation_)||(timeProvider.timeStep()%adaptationsteps_!=0))
+      return;
+    auto& curvature(solution.template subDiscreteFunction<0>());
+    auto& displacement(solution.template subDiscreteFunction<1>());
+    // mark entities with the indicator h|k|
+    ConstLocalFunction<CurvatureDiscreteFunctionType> localCurvature(curvature);
+    typename CurvatureDiscreteFunctionType::RangeType value;
+    std::size_t numRefined(0);
+    std::size_t numCoarsened(0);
+    for(const auto& entity:space_)
+    {
+      localCurvature.init(entity);
+      localCurvature.evaluate(referenceElement(entity.geometry()).position(0,0),value);
+      const auto h(std::pow(std::abs(entity.geometry().volume()),1.0/static_cast<double>(GridType::dimension)));
+      const auto indicator(h*std::abs(value[0]));
+      if(indicator>refinetolerance_&&entity.level()<maxlevel_)
+      {
+        grid_.mark(1,entity);
+        ++numRefined;
+      }
+      else if(indicator<coarsentolerance_&&entity.level()>0)
+      {
+        grid_.mark(-1,entity);
+        ++numCoarsened;
+      }
+    }
+    if(numRefined+numCoarsened==0)
+      return;
+    // adapt grid, the vertex function interpolates the coordinates while the solution and the previous displacement are projected
+    typedef RestrictProlongDefaultTuple<CurvatureDiscreteFunctionType,DisplacementDiscreteFunctionType,
+                                        DisplacementDiscreteFunctionType> RestrictProlongType;
+    RestrictProlongType restrictProlong(curvature,displacement,olddisplacement_);
+    AdaptationManager<GridType,RestrictProlongType> adaptationManager(grid_,restrictProlong);
+    adaptationManager.adapt();
+    isadapted_=true;
+    checkVertexNumbering();
+    // rebuild stencil and active set
+    op_.reserve();
+    resetActiveSet();
+    std::cout<<"Interface adapted: "<<numRefined<<" entities marked for refinement and "<<numCoarsened<<" for coarsening, "
+      <<curvature.size()<<" unkowns for "<<curvature.name()<<" and "<<displacement.size()<<" unkowns for "<<displacement.name()<<".\n";
   }
 
   private:
+  // freeze the vertices whose displacement stays below the tolerance for several consecutive time steps,
+  // the active set is periodically reset
+  void updateActiveSet(const DiscreteFunctionType& solution)
+  {
+    if(++stepssincerefresh_>=activesetrefreshsteps_)
+    {
+      resetActiveSet();
+      std::cout<<"Active set reset to the whole interface.\n";
+      return;
+    }
+    // curvature dofs and displacement blocks share the lagrange points, hence the same block numbering
+    auto& activeCurvature(activeset_.template subDiscreteFunction<0>());
+    auto& activeDisplacement(activeset_.template subDiscreteFunction<1>());
+    const auto& displacement(solution.template subDiscreteFunction<1>());
+    constexpr std::size_t localBlockSize(DisplacementDiscreteSpaceType::localBlockSize);
+    auto activeCurvatureIt(activeCurvature.dbegin());
+    auto activeDisplacementIt(activeDisplacement.dbegin());
+    auto displacementIt(displacement.dbegin());
+    for(auto& stillSteps:stillsteps_)
+    {
+      double norm2(0.0);
+      for(auto l=decltype(localBlockSize){0};l!=localBlockSize;++l,++displacementIt)
+        norm2+=(*displacementIt)*(*displacementIt);
+      stillSteps=(std::sqrt(norm2)<activesettolerance_?stillSteps+1:0);
+      const double isActive(stillSteps>=activesetfreezesteps_?0.0:1.0);
+      *activeCurvatureIt=isActive;
+      ++activeCurvatureIt;
+      for(auto l=decltype(localBlockSize){0};l!=localBlockSize;++l,++activeDisplacementIt)
+        *activeDisplacementIt=isActive;
+    }
+    std::cout<<"Active set: "<<std::count_if(activeCurvature.dbegin(),activeCurvature.dend(),[](const auto& dof){return dof>0.5;})
+      <<" of "<<activeCurvature.size()<<" nodes.\n";
+  }
+
+  // the displacement is added dof by dof to the coordinates, which live on the host grid, hence the vertices must be
+  // numbered in the same way by the two grid parts
+  void checkVertexNumbering() const
+  {
+    constexpr int griddim(GridType::dimension);
+    const auto& coordinatesIndexSet(grid_.coordFunction().gridPart().indexSet());
+    for(const auto& vertex:vertices(gridpart_))
+      if(gridpart_.indexSet().index(vertex)!=coordinatesIndexSet.index(GridType::template getHostEntity<griddim>(vertex)))
+        DUNE_THROW(InvalidStateException,"the vertices of the coordinates and of the displacement are numbered differently");
+  }
+
+  // replace the frozen dofs with their constrained values
+  template<typename DF>
+  static void constrainDofs(DF& df,const DF& activeSet,const DF& constraints)
+  {
+    auto activeIt(activeSet.dbegin());
+    auto constraintIt(constraints.dbegin());
+    for(auto dfIt=df.dbegin();dfIt!=df.dend();++dfIt,++activeIt,++constraintIt)
+      if(*activeIt<0.5)
+        *dfIt=*constraintIt;
+  }
+
   GridType& grid_;
   GridPartType gridpart_;
   const DiscreteSpaceType space_;
   const bool usemeancurvflow_;
+  const bool useactiveset_;
+  const double activesettolerance_;
+  const unsigned int activesetrefreshsteps_;
+  const unsigned int activesetfreezesteps_;
+  DiscreteFunctionType activeset_;
+  unsigned int stepssincerefresh_;
+  std::vector<unsigned int> stillsteps_;
+  bool lastsolveonwholeinterface_;
+  const bool usebdf2_;
+  DisplacementDiscreteFunctionType olddisplacement_;
+  bool hasolddisplacement_;
+  InterfaceOperatorType op_;
+  // kept across time steps since the multigrid levels depend only on the grid
+  InterfaceInverseOperatorType invop_;
+  const bool useadaptation_;
+  const unsigned int adaptationsteps_;
+  const double refinetolerance_;
+  const double coarsentolerance_;
+  const int maxlevel_;
+  bool isadapted_;
+  double assembletime_;
+  double rhstime_;
+  double solvetime_;
+  unsigned int refinementiterations_;
 };
 
 }
@@ -1,13 +1,17 @@
 #ifndef DUNE_FEM_GNUPLOTWRITER_HH
 #define DUNE_FEM_GNUPLOTWRITER_HH
 
+#include <cstddef>
+#include <cstdint>
 #include <fstream>
+#include <initializer_list>
 #include <iomanip>
-#include <list>
+#include <iterator>
+#include <mutex>
 #include <string>
-#include <tuple>
-#include <utility>
+#include <vector>
 
+#include <dune/common/exceptions.hh>
 #include <dune/fem/io/io.hh>
 #include <dune/fem/io/parameter.hh>
 
@@ -16,47 +20,142 @@ namespace Dune
 namespace Fem
 {
 
-// generic gnuplot writer
-struct GnuplotWriter
+// generic gnuplot writer, each row is an abscissa followed by one value per series
+// the number of columns is fixed by the series names or by the first row, binary files start with it as a 64 bit integer
+// rows are buffered and appended to the file in chunks, hence add can be called from a background thread
+// the file is created only when the first chunk is written, the output path is resolved by the constructor since the
+// parameter container is not thread safe
+class GnuplotWriter
 {
-  typedef std::list<std::tuple<double,double>> ListType;
+  public:
+  GnuplotWriter(const std::string& fileName,unsigned int precision=6,bool binary=false,std::size_t chunkSize=64,
+                const std::vector<std::string>& seriesNames=std::vector<std::string>()):
+    precision_(precision),binary_(binary),chunksize_(chunkSize),seriesnames_(seriesNames),
+    numcolumns_(seriesNames.empty()?0:seriesNames.size()+1),numrows_(0),numbufferedrows_(0)
+  {
+    path_=Parameter::getValue<std::string>("fem.prefix",".");
+    filename_=path_+"/"+fileName+(binary_?".bin":".dat");
+  }
 
-  GnuplotWriter(const std::string& fileName,unsigned int precision=6):
-    filename_(fileName),precision_(precision)
-  {}
+  GnuplotWriter(const GnuplotWriter& )=delete;
+
+  ~GnuplotWriter()
+  {
+    finalize();
+  }
 
   void add(double first,double second)
   {
-    values_.emplace_back(first,second);
+    add(first,{second});
+  }
+
+  void add(double first,std::initializer_list<double> values)
+  {
+    addRow(first,values.begin(),values.end());
+  }
+
+  void add(double first,const std::vector<double>& values)
+  {
+    addRow(first,values.begin(),values.end());
   }
 
   bool isEmpty() const
   {
-    return values_.size()==0;
+    std::lock_guard<std::mutex> guard(mutex_);
+    return numrows_==0;
   }
 
-  ~GnuplotWriter()
+  const std::string& fileName() const
   {
-    finalize();
+    return filename_;
+  }
+
+  // append the buffered rows to the file
+  void finalize()
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    write();
+  }
+
+  private:
+  template<typename IteratorType>
+  void addRow(double first,IteratorType begin,IteratorType end)
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    const std::size_t numColumns(std::distance(begin,end)+1);
+    if(numcolumns_==0)
+      numcolumns_=numColumns;
+    if(numColumns!=numcolumns_)
+      DUNE_THROW(InvalidStateException,"GnuplotWriter: row with "<<numColumns<<" columns added to "<<filename_<<" which has "
+                 <<numcolumns_);
+    buffer_.push_back(first);
+    buffer_.insert(buffer_.end(),begin,end);
+    ++numrows_;
+    if(++numbufferedrows_>=chunksize_)
+      write();
+  }
+
+  void open()
+  {
+    if(!directoryExists(path_))
+      createDirectory(path_);
+    if(binary_)
+    {
+      ofs_.open(filename_,std::ios::out|std::ios::trunc|std::ios::binary);
+      const std::uint64_t numColumns(numcolumns_);
+      ofs_.write(reinterpret_cast<const char*>(&numColumns),sizeof(numColumns));
+    }
+    else
+    {
+      ofs_.open(filename_,std::ios::out|std::ios::trunc);
+      ofs_<<std::setprecision(precision_);
+      if(!seriesnames_.empty())
+      {
+        ofs_<<"#";
+        for(const auto& name:seriesnames_)
+          ofs_<<" "<<name;
+        ofs_<<"\n";
+      }
+    }
   }
 
-  void finalize() const
+  void write()
   {
-    if(!isEmpty())
+    if(numbufferedrows_==0)
+      return;
+    if(!ofs_.is_open())
+      open();
+    if(binary_)
+      ofs_.write(reinterpret_cast<const char*>(buffer_.data()),buffer_.size()*sizeof(double));
+    else
     {
-      const std::string& path(Parameter::getValue<std::string>("fem.prefix","."));
-      if(!directoryExists(path))
-        createDirectory(path);
-      std::ofstream ofs(path+"/"+filename_+".dat");
-      file<<std::setprecision(precision_);
-      for(const auto& value:values_)
-        file<<std::get<0>(value)<<" "<<std::get<1>(value)<<"\n";
+      auto value(buffer_.cbegin());
+      for(auto row=decltype(numbufferedrows_){0};row!=numbufferedrows_;++row)
+      {
+        ofs_<<*value;
+        ++value;
+        for(auto i=decltype(numcolumns_){1};i!=numcolumns_;++i,++value)
+          ofs_<<" "<<*value;
+        ofs_<<"\n";
+      }
     }
+    ofs_.flush();
+    buffer_.clear();
+    numbufferedrows_=0;
   }
 
+  std::string path_;
   std::string filename_;
-  unsigned int precision_;
-  ListType values_;
+  const unsigned int precision_;
+  const bool binary_;
+  const std::size_t chunksize_;
+  const std::vector<std::string> seriesnames_;
+  std::size_t numcolumns_;
+  std::ofstream ofs_;
+  std::vector<double> buffer_;
+  std::size_t numrows_;
+  std::size_t numbufferedrows_;
+  mutable std::mutex mutex_;
 };
 
 }
@@ -0,0 +1,187 @@
+#ifndef DUNE_FEM_INTERFACEHIERARCHY_HH
+#define DUNE_FEM_INTERFACEHIERARCHY_HH
+
+#include <dune/common/exceptions.hh>
+#include <dune/common/fmatrix.hh>
+#include <dune/istl/bcrsmatrix.hh>
+
+#include <cstddef>
+#include <map>
+#include <vector>
+
+namespace Dune
+{
+namespace Fem
+{
+
+// refine globally the interface, the coordinates of the new vertices are interpolated by the vertex function
+template<typename GridType>
+void globalRefineInterface(GridType& grid,unsigned int refinementLevels)
+{
+  for(auto level=decltype(refinementLevels){0};level!=refinementLevels;++level)
+  {
+    for(const auto& entity:elements(grid.leafGridView()))
+      grid.mark(1,entity);
+    grid.preAdapt();
+    grid.adapt();
+    grid.postAdapt();
+  }
+}
+
+// create a BCRS matrix from the entries collected row by row
+template<typename BCRSMatrixType>
+BCRSMatrixType createBCRSMatrix(const std::vector<std::map<std::size_t,typename BCRSMatrixType::block_type>>& entries,std::size_t cols)
+{
+  BCRSMatrixType matrix(entries.size(),cols,BCRSMatrixType::row_wise);
+  for(auto row=matrix.createbegin();row!=matrix.createend();++row)
+    for(const auto& entry:entries[row.index()])
+      row.insert(entry.first);
+  for(auto row=decltype(entries.size()){0};row!=entries.size();++row)
+    for(const auto& entry:entries[row])
+      matrix[row][entry.first]=entry.second;
+  return matrix;
+}
+
+// copy the rows [rowBegin,rowEnd) and the columns [colBegin,colEnd) of a sparse row matrix into a BCRS matrix
+template<typename BCRSMatrixType,typename SparseRowMatrixType>
+BCRSMatrixType extractBCRSMatrix(const SparseRowMatrixType& matrix,std::size_t rowBegin,std::size_t rowEnd,std::size_t colBegin,
+                                 std::size_t colEnd)
+{
+  constexpr int rows(BCRSMatrixType::block_type::rows);
+  constexpr int cols(BCRSMatrixType::block_type::cols);
+  BCRSMatrixType block((rowEnd-rowBegin)/rows,(colEnd-colBegin)/cols,BCRSMatrixType::row_wise);
+  for(auto row=block.createbegin();row!=block.createend();++row)
+    for(int l=0;l!=rows;++l)
+      for(auto idx=matrix.startRow(rowBegin+row.index()*rows+l);idx!=matrix.endRow(rowBegin+row.index()*rows+l);++idx)
+      {
+        const std::size_t col(matrix.realValue(idx).second);
+        if((col>=colBegin)&&(col<colEnd))
+          row.insert((col-colBegin)/cols);
+      }
+  block=0.0;
+  for(auto row=decltype(block.N()){0};row!=block.N();++row)
+    for(int l=0;l!=rows;++l)
+      for(auto idx=matrix.startRow(rowBegin+row*rows+l);idx!=matrix.endRow(rowBegin+row*rows+l);++idx)
+      {
+        const auto entry(matrix.realValue(idx));
+        const std::size_t col(entry.second);
+        if((col>=colBegin)&&(col<colEnd))
+          block[row][(col-colBegin)/cols][l][(col-colBegin)%cols]+=entry.first;
+      }
+  return block;
+}
+
+// copy the dofs of a tuple discrete function into a block vector, the dofs of the first component come first
+template<typename DiscreteFunctionType,typename BlockVectorType>
+void copyToBlockVector(const DiscreteFunctionType& df,BlockVectorType& v)
+{
+  std::size_t i(0);
+  for(auto it=df.template subDiscreteFunction<0>().dbegin();it!=df.template subDiscreteFunction<0>().dend();++it,++i)
+    v[i]=*it;
+  for(auto it=df.template subDiscreteFunction<1>().dbegin();it!=df.template subDiscreteFunction<1>().dend();++it,++i)
+    v[i]=*it;
+}
+
+template<typename BlockVectorType,typename DiscreteFunctionType>
+void copyFromBlockVector(const BlockVectorType& v,DiscreteFunctionType& df)
+{
+  std::size_t i(0);
+  for(auto it=df.template subDiscreteFunction<0>().dbegin();it!=df.template subDiscreteFunction<0>().dend();++it,++i)
+    *it=v[i];
+  for(auto it=df.template subDiscreteFunction<1>().dbegin();it!=df.template subDiscreteFunction<1>().dend();++it,++i)
+    *it=v[i];
+}
+
+// P1 prolongations between the levels of a globally refined interface, the finest level is numbered as the leaf grid part
+template<typename GridPartImp>
+class InterfaceHierarchy
+{
+  public:
+  typedef GridPartImp GridPartType;
+  typedef typename GridPartType::GridType GridType;
+  typedef InterfaceHierarchy<GridPartType> ThisType;
+  typedef BCRSMatrix<FieldMatrix<double,1,1>> ProlongationType;
+  static constexpr unsigned int griddim=GridType::dimension;
+
+  explicit InterfaceHierarchy(const GridPartType& gridPart):
+    gridpart_(gridPart)
+  {
+    update();
+  }
+
+  InterfaceHierarchy(const ThisType& )=delete;
+
+  // number of levels
+  std::size_t size() const
+  {
+    return prolongations_.size()+1;
+  }
+
+  // number of vertices on a level
+  std::size_t numVertices(std::size_t level) const
+  {
+    if(level==static_cast<std::size_t>(maxlevel_))
+      return gridpart_.indexSet().size(griddim);
+    return gridpart_.grid().levelIndexSet(level).size(griddim);
+  }
+
+  // prolongation from level to level+1
+  const ProlongationType& prolongation(std::size_t level) const
+  {
+    return prolongations_[level];
+  }
+
+  // rebuild the prolongations
+  void update()
+  {
+    const auto& grid(gridpart_.grid());
+    maxlevel_=grid.maxLevel();
+    if(grid.size(maxlevel_,0)!=static_cast<int>(gridpart_.indexSet().size(0)))
+      DUNE_THROW(NotImplemented,"InterfaceHierarchy requires a globally refined interface");
+    prolongations_.clear();
+    prolongations_.reserve(maxlevel_);
+    for(int level=0;level!=maxlevel_;++level)
+    {
+      // the corners of a child are interpolated with the barycentric coordinates in the father
+      std::vector<std::map<std::size_t,ProlongationType::block_type>> entries(numVertices(level+1));
+      for(const auto& entity:elements(grid.levelGridView(level+1)))
+      {
+        const auto father(entity.father());
+        const auto geometryInFather(entity.geometryInFather());
+        for(auto corner=decltype(geometryInFather.corners()){0};corner!=geometryInFather.corners();++corner)
+        {
+          const auto x(geometryInFather.corner(corner));
+          auto& row(entries[vertexIndex(entity,corner,level+1)]);
+          double lambda0(1.0);
+          for(auto j=decltype(griddim){0};j!=griddim;++j)
+          {
+            lambda0-=x[j];
+            if(x[j]>1.e-12)
+              row[vertexIndex(father,j+1,level)]=x[j];
+          }
+          if(lambda0>1.e-12)
+            row[vertexIndex(father,0,level)]=lambda0;
+        }
+      }
+      prolongations_.push_back(createBCRSMatrix<ProlongationType>(entries,numVertices(level)));
+    }
+  }
+
+  private:
+  template<typename EntityType>
+  std::size_t vertexIndex(const EntityType& entity,int corner,int level) const
+  {
+    if(level==maxlevel_)
+      return gridpart_.indexSet().subIndex(entity,corner,griddim);
+    return gridpart_.grid().levelIndexSet(level).subIndex(entity,corner,griddim);
+  }
+
+  const GridPartType& gridpart_;
+  int maxlevel_;
+  std::vector<ProlongationType> prolongations_;
+};
+
+}
+}
+
+#endif // DUNE_FEM_INTERFACEHIERARCHY_HH
@@ -10,6 +10,7 @@
 
 #include "normal.hh"
 
+#include <algorithm>
 #include <fstream>
 #include <string>
 #include <vector>
@@ -33,7 +34,9 @@ class InterfaceOperator:public Operator<DiscreteFunctionImp,DiscreteFunctionImp>
 
   explicit InterfaceOperator(const DiscreteSpaceType& space,bool useMeanCurvFlow):
     space_(space),op_("interface operator",space_,space_),usemeancurvflow_(useMeanCurvFlow)
-  {}
+  {
+    reserve();
+  }
 
   InterfaceOperator(const ThisType& )=delete;
 
@@ -66,13 +69,21 @@ class InterfaceOperator:public Operator<DiscreteFunctionImp,DiscreteFunctionImp>
     return op_;
   }
 
-  // assemble operator, use null velocity to compute initial curvature of interface
-  template<typename TimeProviderType>
-  void assemble(const TimeProviderType& timeProvider,bool velocityNotNull)
+  // allocate matrix, the stencil needs to be rebuilt only after the grid is adapted
+  void reserve()
   {
-    // allocate matrix
     DiagonalAndNeighborStencil<DiscreteSpaceType,DiscreteSpaceType> stencil(space_,space_);
     op_.reserve(stencil);
+  }
+
+  // assemble operator, use null velocity to compute initial curvature of interface
+  // the new displacement enters the discrete time derivative scaled by timeDerivativeCoeff
+  // if an active set is given, only the entities with active dofs are assembled and the frozen dofs are replaced by unit rows
+  template<typename TimeProviderType>
+  void assemble(const TimeProviderType& timeProvider,bool velocityNotNull,double timeDerivativeCoeff=1.0,
+                const DiscreteFunctionType* activeSet=nullptr)
+  {
+    // clear matrix
     op_.clear();
     // allocate local basis
     std::vector<typename DiscreteFunctionType::RangeType> phi(space_.maxNumDofs());
@@ -81,16 +92,33 @@ class InterfaceOperator:public Operator<DiscreteFunctionImp,DiscreteFunctionImp>
     constexpr unsigned int worlddim(DiscreteSpaceType::GridType::dimensionworld);
     constexpr unsigned int rangedim(DiscreteSpaceType::FunctionSpaceType::dimRange);
     typedef typename DiscreteSpaceType::RangeFieldType RangeFieldType;
+    // allocate local active set
+    std::vector<RangeFieldType> localActiveSet(space_.maxNumDofs(),1.0);
+    std::vector<bool> isActive(space_.maxNumDofs(),true);
     // assemble global matrix
     for(const auto& entity:space_)
     {
-      // compute normal
-      const auto normalVector(computeNormal(entity));
       // extract local matrix and basis functions
       auto localMatrix(op_.localMatrix(entity,entity));
       const auto columnLocalSize(localMatrix.columns());
       const auto rowLocalSize(localMatrix.rows());
       const auto& baseSet(localMatrix.domainBasisFunctionSet());
+      // extract active dofs and set unit rows for the frozen ones
+      if(activeSet)
+      {
+        activeSet->getLocalDofs(entity,localActiveSet);
+        for(auto i=decltype(rowLocalSize){0};i!=rowLocalSize;++i)
+        {
+          isActive[i]=(localActiveSet[i]>0.5);
+          if(!isActive[i])
+            localMatrix.set(i,i,1.0);
+        }
+        // skip the entity if all its dofs are frozen
+        if(std::none_of(isActive.begin(),isActive.begin()+rowLocalSize,[](bool active){return active;}))
+          continue;
+      }
+      // compute normal
+      const auto normalVector(computeNormal(entity));
       // assemble local matrix
       const CachingLumpingQuadrature<typename DiscreteSpaceType::GridPartType,0> quadrature(entity, 0);
       for(const auto& qp:quadrature)
@@ -103,27 +131,29 @@ class InterfaceOperator:public Operator<DiscreteFunctionImp,DiscreteFunctionImp>
         if(velocityNotNull)
         {
           for(auto i=decltype(worlddim){0};i!=worlddim;++i)
-            for(auto j=decltype(worlddim){0};j!=worlddim;++j)
+            if(isActive[i])
+              for(auto j=decltype(worlddim){0};j!=worlddim;++j)
+              {
+                RangeFieldType value(0.0);
+                if(usemeancurvflow_)
+                  value=phi[i][0]*phi[j][0];
+                else
+                  value=gradphi[i][0]*gradphi[j][0];
+                value*=weight;
+                localMatrix.add(i,j,value);
+              }
+        }
+        // fill \vec{A_m} (position)
+        for(auto i=decltype(rowLocalSize){worlddim};i!=rowLocalSize;++i)
+          if(isActive[i])
+            for(auto j=decltype(columnLocalSize){worlddim};j!=columnLocalSize;++j)
             {
               RangeFieldType value(0.0);
-              if(usemeancurvflow_)
-                value=phi[i][0]*phi[j][0];
-              else
-                value=gradphi[i][0]*gradphi[j][0];
+              for(auto k=decltype(rangedim){1};k!=rangedim;++k)
+                value+=gradphi[i][k]*gradphi[j][k];
               value*=weight;
               localMatrix.add(i,j,value);
             }
-        }
-        // fill \vec{A_m} (position)
-        for(auto i=decltype(rowLocalSize){worlddim};i!=rowLocalSize;++i)
-          for(auto j=decltype(columnLocalSize){worlddim};j!=columnLocalSize;++j)
-          {
-            RangeFieldType value(0.0);
-            for(auto k=decltype(rangedim){1};k!=rangedim;++k)
-              value+=gradphi[i][k]*gradphi[j][k];
-            value*=weight;
-            localMatrix.add(i,j,value);
-          }
         // fill \vec{N_m} (curvature_j-position_i) and \vec{N_m}^T
         for(auto i=decltype(rowLocalSize){worlddim};i!=rowLocalSize;++i)
           for(auto j=decltype(worlddim){0};j!=worlddim;++j)
@@ -132,8 +162,10 @@ class InterfaceOperator:public Operator<DiscreteFunctionImp,DiscreteFunctionImp>
             for(auto index=decltype(worlddim){0};index!=worlddim;++index)
               value+=phi[i][index+1]*normalVector[index];
             value*=weight*phi[j][0];
-            localMatrix.add(i,j,value);
-            localMatrix.add(j,i,-1.0*value/(timeProvider.deltaT()));
+            if(isActive[i])
+              localMatrix.add(i,j,value);
+            if(isActive[j])
+              localMatrix.add(j,i,-1.0*timeDerivativeCoeff*value/(timeProvider.deltaT()));
           }
       }
     }
@@ -2,8 +2,11 @@
 #define DUNE_FEM_MISCDEBUG_HH
 
 #include <algorithm>
+#include <cstddef>
 #include <cstdlib>
 #include <limits>
+#include <string>
+#include <vector>
 
 #include "gnuplotwriter.hh"
 
@@ -17,8 +20,9 @@ struct InterfaceVolumeInfo:public GnuplotWriter
 {
   typedef GnuplotWriter BaseType;
 
-  InterfaceVolumeInfo(unsigned int precision=6):
-    BaseType("interface_volume",precision)
+  InterfaceVolumeInfo(unsigned int precision=6,bool binary=false,std::size_t chunkSize=64,
+                      const std::vector<std::string>& seriesNames=std::vector<std::string>()):
+    BaseType("interface_volume",precision,binary,chunkSize,seriesNames)
   {}
 
   using BaseType::add;
@@ -38,8 +42,9 @@ struct EntityRatioInfo:public GnuplotWriter
 {
   typedef GnuplotWriter BaseType;
 
-  EntityRatioInfo(unsigned int precision=6):
-    BaseType("entity_ratio",precision)
+  EntityRatioInfo(unsigned int precision=6,bool binary=false,std::size_t chunkSize=64,
+                  const std::vector<std::string>& seriesNames=std::vector<std::string>()):
+    BaseType("entity_ratio",precision,binary,chunkSize,seriesNames)
   {}
 
   using BaseType::add;
@@ -64,8 +69,9 @@ struct AverageRadiusInfo:public GnuplotWriter
 {
   typedef GnuplotWriter BaseType;
 
-  AverageRadiusInfo(unsigned int precision=6):
-    BaseType("average_radius",precision)
+  AverageRadiusInfo(unsigned int precision=6,bool binary=false,std::size_t chunkSize=64,
+                    const std::vector<std::string>& seriesNames=std::vector<std::string>()):
+    BaseType("average_radius",precision,binary,chunkSize,seriesNames)
   {}
 
   using BaseType::add;
@@ -0,0 +1,118 @@
+#ifndef DUNE_FEM_MIXEDPRECISIONINVERSEOPERATOR_HH
+#define DUNE_FEM_MIXEDPRECISIONINVERSEOPERATOR_HH
+
+#include <dune/common/exceptions.hh>
+#include <dune/common/fmatrix.hh>
+#include <dune/common/fvector.hh>
+#include <dune/istl/bcrsmatrix.hh>
+#include <dune/istl/bvector.hh>
+#include <dune/istl/solver.hh>
+#include <dune/istl/superlu.hh>
+
+#include <dune/fem/io/parameter.hh>
+
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+
+#include "interfacehierarchy.hh"
+
+#if HAVE_SUPERLU
+
+namespace Dune
+{
+namespace Fem
+{
+
+// direct solver which factorizes the interface system in single precision with SuperLU, the residual is computed in
+// double precision and the solution is improved by iterative refinement
+template<typename DiscreteFunctionImp,typename LinearOperatorImp>
+class MixedPrecisionInverseOperator
+{
+  public:
+  typedef DiscreteFunctionImp DiscreteFunctionType;
+  typedef LinearOperatorImp LinearOperatorType;
+  typedef MixedPrecisionInverseOperator<DiscreteFunctionType,LinearOperatorType> ThisType;
+  typedef BCRSMatrix<FieldMatrix<float,1,1>> MatrixType;
+  typedef BlockVector<FieldVector<float,1>> VectorType;
+  typedef SuperLU<MatrixType> SolverType;
+
+  MixedPrecisionInverseOperator():
+    reduction_(Parameter::getValue<double>("fem.solver.reduction",1.e-10)),
+    verbose_(Parameter::getValue<int>("fem.solver.verbose",0)),
+    maxrefinements_(Parameter::getValue<unsigned int>("fem.solver.refinement.maxiterations",20)),
+    op_(nullptr),refinementiterations_(0)
+  {}
+
+  MixedPrecisionInverseOperator(const ThisType& )=delete;
+
+  // copy the system in single precision and factorize it, SuperLU keeps its own copy of the matrix
+  void bind(const LinearOperatorType& op)
+  {
+    op_=&op;
+    const auto& matrix(op.matrix());
+    size_=matrix.rows();
+    solver_.reset(new SolverType(extractBCRSMatrix<MatrixType>(matrix,0,size_,0,size_),verbose_));
+  }
+
+  void unbind()
+  {
+    solver_.reset();
+    op_=nullptr;
+  }
+
+  void operator()(const DiscreteFunctionType& rhs,DiscreteFunctionType& solution) const
+  {
+    DiscreteFunctionType residual("residual",rhs.space());
+    DiscreteFunctionType correction("correction",rhs.space());
+    VectorType r(size_);
+    VectorType e(size_);
+    const double rhsNorm(std::sqrt(rhs.scalarProductDofs(rhs)));
+    double residualNorm(0.0);
+    refinementiterations_=0;
+    while(true)
+    {
+      // compute residual in double precision
+      op_->apply(solution,residual);
+      residual-=rhs;
+      residual*=-1.0;
+      residualNorm=std::sqrt(residual.scalarProductDofs(residual));
+      if(residualNorm<=reduction_*rhsNorm)
+        break;
+      if(refinementiterations_==maxrefinements_)
+        DUNE_THROW(InvalidStateException,"iterative refinement stalled after "<<refinementiterations_<<" iterations (relative residual "
+                   <<(rhsNorm>0.0?residualNorm/rhsNorm:residualNorm)<<", requested "<<reduction_<<")");
+      // compute correction with the single precision factorization
+      copyToBlockVector(residual,r);
+      InverseOperatorResult result;
+      solver_->apply(e,r,result);
+      copyFromBlockVector(e,correction);
+      solution+=correction;
+      ++refinementiterations_;
+    }
+    std::cout<<"Iterative refinement iterations: "<<refinementiterations_<<" (relative residual: "
+      <<(rhsNorm>0.0?residualNorm/rhsNorm:residualNorm)<<").\n";
+  }
+
+  unsigned int refinementIterations() const
+  {
+    return refinementiterations_;
+  }
+
+  private:
+  const double reduction_;
+  const int verbose_;
+  const unsigned int maxrefinements_;
+  const LinearOperatorType* op_;
+  std::size_t size_;
+  std::unique_ptr<SolverType> solver_;
+  mutable unsigned int refinementiterations_;
+};
+
+}
+}
+
+#endif // HAVE_SUPERLU
+
+#endif // DUNE_FEM_MIXEDPRECISIONINVERSEOPERATOR_HH
@@ -0,0 +1,435 @@
+#ifndef DUNE_FEM_MULTIGRIDINVERSEOPERATOR_HH
+#define DUNE_FEM_MULTIGRIDINVERSEOPERATOR_HH
+
+#include <dune/common/exceptions.hh>
+#include <dune/common/fmatrix.hh>
+#include <dune/common/fvector.hh>
+#include <dune/istl/bcrsmatrix.hh>
+#include <dune/istl/bvector.hh>
+#include <dune/istl/matrixmatrix.hh>
+#include <dune/istl/operators.hh>
+#include <dune/istl/preconditioner.hh>
+#include <dune/istl/solvers.hh>
+#include <dune/istl/umfpack.hh>
+
+#include <dune/fem/io/parameter.hh>
+
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "interfacehierarchy.hh"
+
+namespace Dune
+{
+namespace Fem
+{
+
+// geometric multigrid V-cycle with damped Jacobi smoothing and Galerkin coarse operators for a matrix made of
+// blockSize x blockSize blocks, the coarsest level is factorized in double precision
+template<typename FieldImp,int blockSize>
+class BlockMultigrid
+{
+  public:
+  typedef FieldImp FieldType;
+  typedef BlockMultigrid<FieldType,blockSize> ThisType;
+  typedef BCRSMatrix<FieldMatrix<FieldType,blockSize,blockSize>> MatrixType;
+  typedef BlockVector<FieldVector<FieldType,blockSize>> VectorType;
+  // UMFPACK is only available in double precision
+  typedef BCRSMatrix<FieldMatrix<double,blockSize,blockSize>> CoarseMatrixType;
+  typedef BlockVector<FieldVector<double,blockSize>> CoarseVectorType;
+  typedef UMFPack<CoarseMatrixType> CoarseSolverType;
+
+  BlockMultigrid(unsigned int smoothingSteps,double relaxation,int verbose):
+    smoothingsteps_(smoothingSteps),relaxation_(relaxation),verbose_(verbose)
+  {}
+
+  BlockMultigrid(const ThisType& )=delete;
+
+  // create the block prolongations, they depend only on the grid
+  template<typename HierarchyType>
+  void setup(const HierarchyType& hierarchy)
+  {
+    const auto numLevels(hierarchy.size());
+    prolongations_.clear();
+    for(auto level=decltype(numLevels){0};level!=numLevels-1;++level)
+    {
+      const auto& scalarProlongation(hierarchy.prolongation(level));
+      std::vector<std::map<std::size_t,typename MatrixType::block_type>> prolongationEntries(scalarProlongation.N());
+      for(auto rowIt=scalarProlongation.begin();rowIt!=scalarProlongation.end();++rowIt)
+        for(auto colIt=rowIt->begin();colIt!=rowIt->end();++colIt)
+        {
+          auto& block(prolongationEntries[rowIt.index()].emplace(colIt.index(),0.0).first->second);
+          for(int l=0;l!=blockSize;++l)
+            block[l][l]=(*colIt)[0][0];
+        }
+      prolongations_.push_back(createBCRSMatrix<MatrixType>(prolongationEntries,scalarProlongation.M()));
+    }
+  }
+
+  // build the levels from the finest matrix with the Galerkin coarse operators, the diagonal of the coarsest level is
+  // relatively shifted by coarseShift
+  void bind(MatrixType&& matrix,double coarseShift)
+  {
+    const auto numLevels(prolongations_.size()+1);
+    matrices_.clear();
+    matrices_.resize(numLevels);
+    matrices_.back()=std::move(matrix);
+    for(auto level=numLevels-1;level!=0;--level)
+    {
+      MatrixType temp;
+      matMultMat(temp,matrices_[level],prolongations_[level-1]);
+      transposeMatMultMat(matrices_[level-1],prolongations_[level-1],temp);
+    }
+    // compute the inverse block diagonals used by the Jacobi smoother
+    invdiagonals_.resize(numLevels);
+    for(auto level=decltype(numLevels){0};level!=numLevels;++level)
+    {
+      invdiagonals_[level].resize(matrices_[level].N());
+      for(auto i=decltype(matrices_[level].N()){0};i!=matrices_[level].N();++i)
+      {
+        invdiagonals_[level][i]=matrices_[level][i][i];
+        invdiagonals_[level][i].invert();
+      }
+    }
+    // factorize the coarsest level
+    std::vector<std::map<std::size_t,typename CoarseMatrixType::block_type>> coarseEntries(matrices_[0].N());
+    for(auto rowIt=matrices_[0].begin();rowIt!=matrices_[0].end();++rowIt)
+      for(auto colIt=rowIt->begin();colIt!=rowIt->end();++colIt)
+      {
+        auto& block(coarseEntries[rowIt.index()].emplace(colIt.index(),0.0).first->second);
+        for(int l=0;l!=blockSize;++l)
+          for(int k=0;k!=blockSize;++k)
+            block[l][k]=(*colIt)[l][k];
+        if(rowIt.index()==colIt.index())
+          for(int l=0;l!=blockSize;++l)
+            block[l][l]*=1.0+coarseShift;
+      }
+    coarsematrix_=createBCRSMatrix<CoarseMatrixType>(coarseEntries,matrices_[0].M());
+    coarsesolver_.reset(new CoarseSolverType(coarsematrix_,verbose_));
+  }
+
+  // apply one V-cycle with null initial guess
+  void apply(VectorType& x,const VectorType& b) const
+  {
+    x=0.0;
+    vcycle(matrices_.size()-1,x,b);
+  }
+
+  private:
+  void vcycle(std::size_t level,VectorType& x,const VectorType& b) const
+  {
+    if(level==0)
+    {
+      CoarseVectorType coarseB(b.size());
+      CoarseVectorType coarseX(b.size());
+      for(auto i=decltype(b.size()){0};i!=b.size();++i)
+        for(int l=0;l!=blockSize;++l)
+          coarseB[i][l]=b[i][l];
+      InverseOperatorResult result;
+      coarsesolver_->apply(coarseX,coarseB,result);
+      for(auto i=decltype(x.size()){0};i!=x.size();++i)
+        for(int l=0;l!=blockSize;++l)
+          x[i][l]=coarseX[i][l];
+      return;
+    }
+    const auto& matrix(matrices_[level]);
+    const auto& prolongation(prolongations_[level-1]);
+    // pre-smoothing
+    smooth(level,x,b);
+    // coarse grid correction
+    VectorType residual(b);
+    matrix.mmv(x,residual);
+    VectorType coarseB(prolongation.M());
+    prolongation.mtv(residual,coarseB);
+    VectorType coarseX(coarseB.size());
+    coarseX=0.0;
+    vcycle(level-1,coarseX,coarseB);
+    prolongation.umv(coarseX,x);
+    // post-smoothing
+    smooth(level,x,b);
+  }
+
+  // damped Jacobi
+  void smooth(std::size_t level,VectorType& x,const VectorType& b) const
+  {
+    const auto& matrix(matrices_[level]);
+    VectorType residual(b.size());
+    for(auto step=decltype(smoothingsteps_){0};step!=smoothingsteps_;++step)
+    {
+      residual=b;
+      matrix.mmv(x,residual);
+      for(auto i=decltype(x.size()){0};i!=x.size();++i)
+        invdiagonals_[level][i].usmv(static_cast<FieldType>(relaxation_),residual[i],x[i]);
+    }
+  }
+
+  const unsigned int smoothingsteps_;
+  const double relaxation_;
+  const int verbose_;
+  std::vector<MatrixType> matrices_;
+  std::vector<MatrixType> prolongations_;
+  std::vector<std::vector<typename MatrixType::block_type>> invdiagonals_;
+  CoarseMatrixType coarsematrix_;
+  std::unique_ptr<CoarseSolverType> coarsesolver_;
+};
+
+// GMRes on the interface system [K B; N A] preconditioned by the upper block triangular preconditioner [S B; 0 A]:
+// the displacement laplacian A and the approximate Schur complement S=K-B D^{-1} N, with D=diag(A), are inverted by a
+// multigrid V-cycle; if K is null, as for the initial curvature, S^{-1} is approximated by the least squares commutator
+// -G^{-1} (B D^{-1} A D^{-1} N) G^{-1} with G=B D^{-1} N
+// GMRes and the preconditioner work in FieldImp precision, the residual is computed in double precision and the
+// solution is improved by iterative refinement
+template<typename DiscreteFunctionImp,typename LinearOperatorImp,typename FieldImp=double>
+class MultigridInverseOperator
+{
+  public:
+  typedef DiscreteFunctionImp DiscreteFunctionType;
+  typedef LinearOperatorImp LinearOperatorType;
+  typedef FieldImp FieldType;
+  typedef MultigridInverseOperator<DiscreteFunctionType,LinearOperatorType,FieldType> ThisType;
+  typedef typename DiscreteFunctionType::DiscreteFunctionSpaceType DiscreteSpaceType;
+  typedef typename DiscreteSpaceType::GridPartType GridPartType;
+  typedef InterfaceHierarchy<GridPartType> HierarchyType;
+  static constexpr int worlddim=GridPartType::GridType::dimensionworld;
+
+  typedef BCRSMatrix<FieldMatrix<FieldType,1,1>> MatrixType;
+  typedef BlockVector<FieldVector<FieldType,1>> VectorType;
+  typedef BlockMultigrid<FieldType,1> CurvatureMultigridType;
+  typedef BlockMultigrid<FieldType,worlddim> DisplacementMultigridType;
+  typedef typename DisplacementMultigridType::MatrixType BlockMatrixType;
+  typedef typename DisplacementMultigridType::VectorType BlockVectorType;
+  typedef BCRSMatrix<FieldMatrix<FieldType,1,worlddim>> CouplingMatrixType;
+
+  MultigridInverseOperator():
+    reduction_(Parameter::getValue<double>("fem.solver.reduction",1.e-10)),
+    maxiterations_(Parameter::getValue<int>("fem.solver.maxiterations",1000)),
+    restart_(Parameter::getValue<int>("fem.solver.gmres.restart",50)),
+    verbose_(Parameter::getValue<int>("fem.solver.verbose",0)),
+    coarseshift_(Parameter::getValue<double>("fem.solver.multigrid.coarseshift",1.e-2)),
+    innerreduction_(Parameter::getValue<double>("fem.solver.refinement.innerreduction",1.e-4)),
+    maxrefinements_(Parameter::getValue<unsigned int>("fem.solver.refinement.maxiterations",20)),
+    curvaturemultigrid_(Parameter::getValue<unsigned int>("fem.solver.multigrid.smoothingsteps",2),
+                        Parameter::getValue<double>("fem.solver.multigrid.relaxation",2.0/3.0),verbose_),
+    displacementmultigrid_(Parameter::getValue<unsigned int>("fem.solver.multigrid.smoothingsteps",2),
+                           Parameter::getValue<double>("fem.solver.multigrid.relaxation",2.0/3.0),verbose_),
+    op_(nullptr),hierarchy_(nullptr),sequence_(-1),usecommutator_(false),iterations_(0),refinementiterations_(0)
+  {}
+
+  MultigridInverseOperator(const ThisType& )=delete;
+
+  // split the system, approximate the Schur complement and build the multigrid levels
+  void bind(const LinearOperatorType& op)
+  {
+    op_=&op;
+    const auto& space(op.domainSpace());
+    numcurvaturedofs_=space.template subDiscreteFunctionSpace<0>().size();
+    // the hierarchy depends only on the grid, hence it is rebuilt only after the grid has changed
+    if((!hierarchy_)||(sequence_!=space.sequence()))
+    {
+      hierarchy_.reset(new HierarchyType(space.gridPart()));
+      curvaturemultigrid_.setup(*hierarchy_);
+      displacementmultigrid_.setup(*hierarchy_);
+      sequence_=space.sequence();
+    }
+    // split the system matrix into the blocks K, B, N and A
+    const auto& matrix(op.matrix());
+    const std::size_t size(matrix.rows());
+    const std::size_t numDisplacementDofs(size-numcurvaturedofs_);
+    matrix_=extractBCRSMatrix<MatrixType>(matrix,0,size,0,size);
+    coupling_=extractBCRSMatrix<CouplingMatrixType>(matrix,0,numcurvaturedofs_,numcurvaturedofs_,size);
+    auto displacementMatrix(extractBCRSMatrix<BlockMatrixType>(matrix,numcurvaturedofs_,size,numcurvaturedofs_,size));
+    const auto curvatureMatrix(extractBCRSMatrix<MatrixType>(matrix,0,numcurvaturedofs_,0,numcurvaturedofs_));
+    // scale B and N with D^{-1}, D=diag(A), from the right and from the left respectively
+    auto upperCoupling(extractBCRSMatrix<MatrixType>(matrix,0,numcurvaturedofs_,numcurvaturedofs_,size));
+    auto lowerCoupling(extractBCRSMatrix<MatrixType>(matrix,numcurvaturedofs_,size,0,numcurvaturedofs_));
+    std::vector<FieldType> invDiagonal(numDisplacementDofs);
+    for(auto dof=decltype(numDisplacementDofs){0};dof!=numDisplacementDofs;++dof)
+      invDiagonal[dof]=1.0/displacementMatrix[dof/worlddim][dof/worlddim][dof%worlddim][dof%worlddim];
+    for(auto rowIt=upperCoupling.begin();rowIt!=upperCoupling.end();++rowIt)
+      for(auto colIt=rowIt->begin();colIt!=rowIt->end();++colIt)
+        *colIt*=invDiagonal[colIt.index()];
+    for(auto rowIt=lowerCoupling.begin();rowIt!=lowerCoupling.end();++rowIt)
+      *rowIt*=invDiagonal[rowIt.index()];
+    // approximate the Schur complement K-B A^{-1} N replacing the displacement laplacian with its diagonal
+    MatrixType coupling;
+    matMultMat(coupling,upperCoupling,lowerCoupling);
+    usecommutator_=(curvatureMatrix.frobenius_norm()==0.0);
+    // compute the commutator B D^{-1} A D^{-1} N
+    if(usecommutator_)
+    {
+      MatrixType temp;
+      matMultMat(temp,extractBCRSMatrix<MatrixType>(matrix,numcurvaturedofs_,size,numcurvaturedofs_,size),lowerCoupling);
+      matMultMat(commutator_,upperCoupling,temp);
+    }
+    // build the multigrid levels, the curvature one inverts S or -G, the displacement laplacian is singular,
+    // hence its coarsest level is shifted
+    curvaturemultigrid_.bind(subtract(curvatureMatrix,coupling),0.0);
+    displacementmultigrid_.bind(std::move(displacementMatrix),coarseshift_);
+  }
+
+  void unbind()
+  {
+    op_=nullptr;
+  }
+
+  void operator()(const DiscreteFunctionType& rhs,DiscreteFunctionType& solution) const
+  {
+    // in double precision a single correction reaches the requested reduction
+    const bool mixedPrecision(!std::is_same<FieldType,double>::value);
+    MatrixAdapter<MatrixType,VectorType,VectorType> linearOperator(matrix_);
+    BlockPreconditioner preconditioner(*this);
+    RestartedGMResSolver<VectorType> solver(linearOperator,preconditioner,mixedPrecision?innerreduction_:reduction_,restart_,
+                                            maxiterations_,verbose_);
+    DiscreteFunctionType residual("residual",rhs.space());
+    DiscreteFunctionType correction("correction",rhs.space());
+    VectorType r(matrix_.N());
+    VectorType e(matrix_.N());
+    const double rhsNorm(std::sqrt(rhs.scalarProductDofs(rhs)));
+    double residualNorm(0.0);
+    iterations_=0;
+    refinementiterations_=0;
+    while(true)
+    {
+      // compute residual in double precision
+      op_->apply(solution,residual);
+      residual-=rhs;
+      residual*=-1.0;
+      residualNorm=std::sqrt(residual.scalarProductDofs(residual));
+      if(residualNorm<=reduction_*rhsNorm)
+        break;
+      if(refinementiterations_==maxrefinements_)
+        DUNE_THROW(InvalidStateException,"iterative refinement stalled after "<<refinementiterations_<<" iterations (relative residual "
+                   <<(rhsNorm>0.0?residualNorm/rhsNorm:residualNorm)<<", requested "<<reduction_<<")");
+      // compute correction in FieldType precision
+      copyToBlockVector(residual,r);
+      e=0.0;
+      InverseOperatorResult result;
+      solver.apply(e,r,result);
+      iterations_+=result.iterations;
+      copyFromBlockVector(e,correction);
+      solution+=correction;
+      ++refinementiterations_;
+    }
+    std::cout<<"Iterative refinement iterations: "<<refinementiterations_<<" (GMRes iterations: "<<iterations_
+      <<", relative residual: "<<(rhsNorm>0.0?residualNorm/rhsNorm:residualNorm)<<").\n";
+  }
+
+  int iterations() const
+  {
+    return iterations_;
+  }
+
+  unsigned int refinementIterations() const
+  {
+    return refinementiterations_;
+  }
+
+  private:
+  // block triangular preconditioner
+  struct BlockPreconditioner:public Dune::Preconditioner<VectorType,VectorType>
+  {
+    explicit BlockPreconditioner(const ThisType& inverseOperator):
+      inverseoperator_(inverseOperator)
+    {}
+
+    void pre(VectorType& ,VectorType& ) override
+    {}
+
+    void apply(VectorType& v,const VectorType& d) override
+    {
+      inverseoperator_.applyPreconditioner(v,d);
+    }
+
+    void post(VectorType& ) override
+    {}
+
+    SolverCategory::Category category() const override
+    {
+      return SolverCategory::sequential;
+    }
+
+    const ThisType& inverseoperator_;
+  };
+
+  void applyPreconditioner(VectorType& v,const VectorType& d) const
+  {
+    // V-cycle on the displacement
+    BlockVectorType displacementD(coupling_.M());
+    for(auto i=decltype(displacementD.size()){0};i!=displacementD.size();++i)
+      for(int l=0;l!=worlddim;++l)
+        displacementD[i][l]=d[numcurvaturedofs_+i*worlddim+l][0];
+    BlockVectorType displacementV(displacementD.size());
+    displacementmultigrid_.apply(displacementV,displacementD);
+    for(auto i=decltype(displacementV.size()){0};i!=displacementV.size();++i)
+      for(int l=0;l!=worlddim;++l)
+        v[numcurvaturedofs_+i*worlddim+l]=displacementV[i][l];
+    // V-cycles on the Schur complement with the curvature residual corrected by the coupling
+    VectorType curvatureD(numcurvaturedofs_);
+    for(auto i=decltype(numcurvaturedofs_){0};i!=numcurvaturedofs_;++i)
+      curvatureD[i]=d[i];
+    coupling_.mmv(displacementV,curvatureD);
+    VectorType curvatureV(numcurvaturedofs_);
+    curvaturemultigrid_.apply(curvatureV,curvatureD);
+    if(usecommutator_)
+    {
+      VectorType commutatorD(numcurvaturedofs_);
+      commutator_.mv(curvatureV,commutatorD);
+      curvaturemultigrid_.apply(curvatureV,commutatorD);
+      curvatureV*=-1.0;
+    }
+    for(auto i=decltype(numcurvaturedofs_){0};i!=numcurvaturedofs_;++i)
+      v[i]=curvatureV[i];
+  }
+
+  // a-b on the union of the sparsity patterns
+  static MatrixType subtract(const MatrixType& a,const MatrixType& b)
+  {
+    MatrixType c(a.N(),a.M(),MatrixType::row_wise);
+    for(auto row=c.createbegin();row!=c.createend();++row)
+    {
+      for(auto colIt=a[row.index()].begin();colIt!=a[row.index()].end();++colIt)
+        row.insert(colIt.index());
+      for(auto colIt=b[row.index()].begin();colIt!=b[row.index()].end();++colIt)
+        row.insert(colIt.index());
+    }
+    c=0.0;
+    for(auto rowIt=a.begin();rowIt!=a.end();++rowIt)
+      for(auto colIt=rowIt->begin();colIt!=rowIt->end();++colIt)
+        c[rowIt.index()][colIt.index()]+=*colIt;
+    for(auto rowIt=b.begin();rowIt!=b.end();++rowIt)
+      for(auto colIt=rowIt->begin();colIt!=rowIt->end();++colIt)
+        c[rowIt.index()][colIt.index()]-=*colIt;
+    return c;
+  }
+
+  const double reduction_;
+  const int maxiterations_;
+  const int restart_;
+  const int verbose_;
+  const double coarseshift_;
+  const double innerreduction_;
+  const unsigned int maxrefinements_;
+  CurvatureMultigridType curvaturemultigrid_;
+  DisplacementMultigridType displacementmultigrid_;
+  const LinearOperatorType* op_;
+  std::unique_ptr<HierarchyType> hierarchy_;
+  int sequence_;
+  std::size_t numcurvaturedofs_;
+  MatrixType matrix_;
+  CouplingMatrixType coupling_;
+  bool usecommutator_;
+  MatrixType commutator_;
+  mutable int iterations_;
+  mutable unsigned int refinementiterations_;
+};
+
+}
+}
+
+#endif // DUNE_FEM_MULTIGRIDINVERSEOPERATOR_HH
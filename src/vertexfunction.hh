@@ -1,14 +1,14 @@
 #ifndef DUNE_FEM_VERTEXFUNCTION_HH
 #define DUNE_FEM_VERTEXFUNCTION_HH
 
-#include <dune/common/exceptions.hh>
 #include <dune/geometry/referenceelements.hh>
 #include <dune/grid/geometrygrid/coordfunction.hh>
 
 #include <dune/fem/function/adaptivefunction.hh>
 #include <dune/fem/function/common/localcontribution.hh>
 #include <dune/fem/function/localfunction/const.hh>
-#include <dune/fem/gridpart/leafgridpart.hh>
+#include <dune/fem/gridpart/adaptiveleafgridpart.hh>
+#include <dune/fem/space/common/dofmanager.hh>
 #include <dune/fem/space/common/functionspace.hh>
 #include <dune/fem/space/lagrange.hh>
 
@@ -29,7 +29,7 @@ class VertexFunction:public DiscreteCoordFunction<typename GridImp::ctype,GridIm
   typedef DiscreteCoordFunction<ctype,worlddim,ThisType> BaseType;
   typedef typename BaseType::RangeVector RangeVectorType;
 
-  typedef LeafGridPart<GridType> GridPartType;
+  typedef AdaptiveLeafGridPart<GridType> GridPartType;
 
   typedef FunctionSpace<ctype,ctype,worlddim,worlddim> ContinuousSpaceType;
   typedef LagrangeDiscreteFunctionSpace<ContinuousSpaceType,GridPartType,1> DiscreteSpaceType;
@@ -52,6 +52,11 @@ class VertexFunction:public DiscreteCoordFunction<typename GridImp::ctype,GridIm
     return *this;
   }
 
+  const GridPartType& gridPart() const
+  {
+    return gridpart_;
+  }
+
   DiscreteFunctionType& discreteFunction()
   {
     return coord_;
@@ -114,9 +119,35 @@ class VertexFunction:public DiscreteCoordFunction<typename GridImp::ctype,GridIm
     coord_.evaluate(vertex.geometry().center(),y);
   }
 
+  // interpolate the coordinates of the vertices created by the refinement of the host grid
   void adapt()
   {
-    DUNE_THROW(NotImplemented,"VertexFunction::adapt() not implemented");
+    auto& dofManager(DofManager<GridType>::instance(gridpart_.grid()));
+    dofManager.resizeMemory();
+    // new entities are visited from coarse to fine, hence their fathers' coordinates are always available
+    LocalContribution<DiscreteFunctionType,Assembly::Set> localCoord(coord_);
+    constexpr std::size_t localBlockSize(DiscreteSpaceType::localBlockSize);
+    const auto& grid(gridpart_.grid());
+    for(int level=1;level<=grid.maxLevel();++level)
+      for(const auto& entity:elements(grid.levelGridView(level)))
+        if(entity.isNew())
+        {
+          const auto father(entity.father());
+          const auto geometryInFather(entity.geometryInFather());
+          localcoord_.init(father);
+          localCoord.bind(entity);
+          const auto numLocalBlocks(geometryInFather.corners());
+          std::size_t row(0);
+          for(auto localIdx=decltype(numLocalBlocks){0};localIdx!=numLocalBlocks;++localIdx)
+          {
+            RangeVectorType x;
+            localcoord_.evaluate(geometryInFather.corner(localIdx),x);
+            for(auto l=decltype(localBlockSize){0};l!=localBlockSize;++l,++row)
+              localCoord[row]=x[l];
+          }
+          localCoord.unbind();
+        }
+    dofManager.compress();
   }
 
   private: